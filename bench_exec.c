@@ -0,0 +1,162 @@
+/*
+ * Exec Startup Benchmark
+ *
+ * Measures the time from fork() to the first byte of output of a command,
+ * which for skey and skey_read is dominated by exec, dynamic linking and
+ * relocation rather than by any actual hashing.
+ *
+ * usage: bench_exec <iterations> <command> [<args> ...]
+ *
+ * The command's stdin is fed a fixed dummy secret / word list, so it works for
+ * both skey (which prompts for a secret) and skey_read (which prompts for six
+ * words). Prints min / median / mean in microseconds.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+static const char bench_input[] = "This is a test.\nA A A A A A\n";
+
+static double elapsed_us(struct timespec *start, struct timespec *end)
+{
+	return (end->tv_sec - start->tv_sec) * 1e6
+		+ (end->tv_nsec - start->tv_nsec) / 1e3;
+}
+
+static int compare_double(const void *a, const void *b)
+{
+	double x = *(const double *) a, y = *(const double *) b;
+	return (x > y) - (x < y);
+}
+
+/*
+ * Run the command once. Returns the fork-to-first-output time in
+ * microseconds, or a negative number on failure.
+ */
+static double run_once(char **cmd)
+{
+	int in_fd[2], out_fd[2], status;
+	pid_t pid;
+	char buf[256];
+	struct timespec start, end;
+	double us;
+
+	if (pipe(in_fd) != 0 || pipe(out_fd) != 0) {
+		perror("pipe");
+		return -1;
+	}
+
+	/* small enough to never block on the pipe buffer */
+	if (write(in_fd[1], bench_input, sizeof(bench_input) - 1) < 0) {
+		perror("write");
+		return -1;
+	}
+	close(in_fd[1]);
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+
+	pid = fork();
+	if (pid < 0) {
+		perror("fork");
+		return -1;
+	} else if (pid == 0) {
+		dup2(in_fd[0], STDIN_FILENO);
+		dup2(out_fd[1], STDOUT_FILENO);
+		dup2(out_fd[1], STDERR_FILENO);
+		close(in_fd[0]);
+		close(out_fd[0]);
+		close(out_fd[1]);
+		execvp(cmd[0], cmd);
+		_exit(127);
+	}
+
+	close(in_fd[0]);
+	close(out_fd[1]);
+
+	if (read(out_fd[0], buf, 1) != 1) {
+		fprintf(stderr, "%s: no output\n", cmd[0]);
+		us = -1;
+	} else {
+		clock_gettime(CLOCK_MONOTONIC, &end);
+		us = elapsed_us(&start, &end);
+	}
+
+	/* drain the rest so the child never blocks on a full pipe */
+	while (read(out_fd[0], buf, sizeof(buf)) > 0)
+		;
+	close(out_fd[0]);
+	waitpid(pid, &status, 0);
+
+	return us;
+}
+
+int main(int argc, char **argv)
+{
+	int i, iterations;
+	double *times, total;
+
+	if (argc < 3 || sscanf(argv[1], "%d", &iterations) < 1
+			|| iterations < 1) {
+		fprintf(stderr, "usage: %s <iterations> <command> [<args> ...]\n",
+				argv[0]);
+		return 1;
+	}
+
+	times = (double*) malloc(iterations * sizeof(double));
+	if (times == NULL) {
+		perror("error allocating timing buffer");
+		return 1;
+	}
+
+	total = 0;
+	for (i = 0; i < iterations; i++) {
+		times[i] = run_once(argv + 2);
+		if (times[i] < 0) {
+			return 1;
+		}
+		total += times[i];
+	}
+
+	qsort(times, iterations, sizeof(double), compare_double);
+
+	printf("%s: %d runs, min %.1f us, median %.1f us, mean %.1f us\n",
+		argv[2], iterations, times[0], times[iterations / 2],
+		total / iterations);
+
+	free(times);
+	return 0;
+}
+
+/*
+
+Copyright (c) 2009, William R. Fraser
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of William R. Fraser nor the names of other
+      contributors may be used to endorse or promote products derived from
+      this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY WILLIAM R. FRASER ''AS IS'' AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL WILLIAM R. FRASER BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+vim: sts=8 ts=8 noexpandtab
+*/
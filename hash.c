@@ -0,0 +1,308 @@
+/*
+ * Built-in MD4 (RFC 1320), MD5 (RFC 1321) and SHA-1 (RFC 3174)
+ *
+ * Only compiled when SKEY_BUILTIN_HASH is defined; provides the handful of
+ * mhash functions skey needs so it can be built without libmhash.
+ *
+ * skey hashes at most a seed plus secret, and then 8 bytes per round, so input
+ * is simply buffered until mhash_end() and digested in one pass.
+ */
+
+#ifdef SKEY_BUILTIN_HASH
+
+#include <stdlib.h>
+#include <string.h>
+#include "hash.h"
+
+struct skey_hash {
+	int hash;
+	unsigned char *buf;
+	size_t buf_sz;
+	size_t alloc;
+};
+
+typedef unsigned int u32;
+
+#define ROL(x, n) (((x) << (n)) | ((x) >> (32 - (n))))
+
+/*
+ * Append the standard MD padding: a 1 bit, zeros up to 56 mod 64, and the
+ * message length in bits, either little-endian (MD4, MD5) or big-endian
+ * (SHA-1). Returns the padded length, or 0 if out of memory.
+ */
+static size_t md_pad(struct skey_hash *h, int big_endian)
+{
+	size_t len, padded, i;
+	unsigned long long bits;
+
+	len = h->buf_sz;
+	padded = (len + 8) / 64 * 64 + 64;
+	if (padded > h->alloc) {
+		unsigned char *buf = (unsigned char*) realloc(h->buf, padded);
+		if (buf == NULL) {
+			return 0;
+		}
+		h->buf = buf;
+		h->alloc = padded;
+	}
+
+	h->buf[len] = 0x80;
+	memset(h->buf + len + 1, 0, padded - len - 1);
+
+	bits = (unsigned long long) len * 8;
+	for (i = 0; i < 8; i++) {
+		h->buf[big_endian ? padded - 1 - i : padded - 8 + i] =
+			(unsigned char) (bits >> (8 * i));
+	}
+
+	return padded;
+}
+
+static u32 get_le(const unsigned char *p)
+{
+	return (u32) p[0] | (u32) p[1] << 8 | (u32) p[2] << 16 | (u32) p[3] << 24;
+}
+
+static u32 get_be(const unsigned char *p)
+{
+	return (u32) p[0] << 24 | (u32) p[1] << 16 | (u32) p[2] << 8 | (u32) p[3];
+}
+
+static void put_le(unsigned char *p, u32 v)
+{
+	p[0] = v; p[1] = v >> 8; p[2] = v >> 16; p[3] = v >> 24;
+}
+
+static void put_be(unsigned char *p, u32 v)
+{
+	p[0] = v >> 24; p[1] = v >> 16; p[2] = v >> 8; p[3] = v;
+}
+
+static void md4(const unsigned char *msg, size_t len, unsigned char out[16])
+{
+	static const int r2[16] = { 0, 4, 8, 12, 1, 5, 9, 13,
+	                            2, 6, 10, 14, 3, 7, 11, 15 };
+	static const int r3[16] = { 0, 8, 4, 12, 2, 10, 6, 14,
+	                            1, 9, 5, 13, 3, 11, 7, 15 };
+	static const int s1[4] = { 3, 7, 11, 19 };
+	static const int s2[4] = { 3, 5, 9, 13 };
+	static const int s3[4] = { 3, 9, 11, 15 };
+	u32 st[4] = { 0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476 };
+	u32 x[16], a, b, c, d, t;
+	size_t off;
+	int i;
+
+	for (off = 0; off < len; off += 64) {
+		for (i = 0; i < 16; i++) {
+			x[i] = get_le(msg + off + 4*i);
+		}
+		a = st[0]; b = st[1]; c = st[2]; d = st[3];
+
+		for (i = 0; i < 48; i++) {
+			if (i < 16) {
+				t = a + ((b & c) | (~b & d)) + x[i];
+				t = ROL(t, s1[i % 4]);
+			} else if (i < 32) {
+				t = a + ((b & c) | (b & d) | (c & d))
+					+ x[r2[i - 16]] + 0x5a827999;
+				t = ROL(t, s2[i % 4]);
+			} else {
+				t = a + (b ^ c ^ d) + x[r3[i - 32]] + 0x6ed9eba1;
+				t = ROL(t, s3[i % 4]);
+			}
+			a = d; d = c; c = b; b = t;
+		}
+
+		st[0] += a; st[1] += b; st[2] += c; st[3] += d;
+	}
+
+	for (i = 0; i < 4; i++) {
+		put_le(out + 4*i, st[i]);
+	}
+}
+
+static void md5(const unsigned char *msg, size_t len, unsigned char out[16])
+{
+	static const int s[64] = {
+		7, 12, 17, 22, 7, 12, 17, 22, 7, 12, 17, 22, 7, 12, 17, 22,
+		5,  9, 14, 20, 5,  9, 14, 20, 5,  9, 14, 20, 5,  9, 14, 20,
+		4, 11, 16, 23, 4, 11, 16, 23, 4, 11, 16, 23, 4, 11, 16, 23,
+		6, 10, 15, 21, 6, 10, 15, 21, 6, 10, 15, 21, 6, 10, 15, 21
+	};
+	static const u32 k[64] = {
+		0xd76aa478, 0xe8c7b756, 0x242070db, 0xc1bdceee,
+		0xf57c0faf, 0x4787c62a, 0xa8304613, 0xfd469501,
+		0x698098d8, 0x8b44f7af, 0xffff5bb1, 0x895cd7be,
+		0x6b901122, 0xfd987193, 0xa679438e, 0x49b40821,
+		0xf61e2562, 0xc040b340, 0x265e5a51, 0xe9b6c7aa,
+		0xd62f105d, 0x02441453, 0xd8a1e681, 0xe7d3fbc8,
+		0x21e1cde6, 0xc33707d6, 0xf4d50d87, 0x455a14ed,
+		0xa9e3e905, 0xfcefa3f8, 0x676f02d9, 0x8d2a4c8a,
+		0xfffa3942, 0x8771f681, 0x6d9d6122, 0xfde5380c,
+		0xa4beea44, 0x4bdecfa9, 0xf6bb4b60, 0xbebfbc70,
+		0x289b7ec6, 0xeaa127fa, 0xd4ef3085, 0x04881d05,
+		0xd9d4d039, 0xe6db99e5, 0x1fa27cf8, 0xc4ac5665,
+		0xf4292244, 0x432aff97, 0xab9423a7, 0xfc93a039,
+		0x655b59c3, 0x8f0ccc92, 0xffeff47d, 0x85845dd1,
+		0x6fa87e4f, 0xfe2ce6e0, 0xa3014314, 0x4e0811a1,
+		0xf7537e82, 0xbd3af235, 0x2ad7d2bb, 0xeb86d391
+	};
+	u32 st[4] = { 0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476 };
+	u32 x[16], a, b, c, d, f, t;
+	size_t off;
+	int i, g;
+
+	for (off = 0; off < len; off += 64) {
+		for (i = 0; i < 16; i++) {
+			x[i] = get_le(msg + off + 4*i);
+		}
+		a = st[0]; b = st[1]; c = st[2]; d = st[3];
+
+		for (i = 0; i < 64; i++) {
+			if (i < 16) {
+				f = (b & c) | (~b & d);
+				g = i;
+			} else if (i < 32) {
+				f = (d & b) | (~d & c);
+				g = (5*i + 1) % 16;
+			} else if (i < 48) {
+				f = b ^ c ^ d;
+				g = (3*i + 5) % 16;
+			} else {
+				f = c ^ (b | ~d);
+				g = (7*i) % 16;
+			}
+			t = a + f + k[i] + x[g];
+			a = d; d = c; c = b;
+			b += ROL(t, s[i]);
+		}
+
+		st[0] += a; st[1] += b; st[2] += c; st[3] += d;
+	}
+
+	for (i = 0; i < 4; i++) {
+		put_le(out + 4*i, st[i]);
+	}
+}
+
+static void sha1(const unsigned char *msg, size_t len, unsigned char out[20])
+{
+	u32 st[5] = { 0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476,
+	              0xc3d2e1f0 };
+	u32 w[80], a, b, c, d, e, f, t;
+	size_t off;
+	int i;
+
+	for (off = 0; off < len; off += 64) {
+		for (i = 0; i < 16; i++) {
+			w[i] = get_be(msg + off + 4*i);
+		}
+		for (i = 16; i < 80; i++) {
+			t = w[i-3] ^ w[i-8] ^ w[i-14] ^ w[i-16];
+			w[i] = ROL(t, 1);
+		}
+		a = st[0]; b = st[1]; c = st[2]; d = st[3]; e = st[4];
+
+		for (i = 0; i < 80; i++) {
+			if (i < 20) {
+				f = ((b & c) | (~b & d)) + 0x5a827999;
+			} else if (i < 40) {
+				f = (b ^ c ^ d) + 0x6ed9eba1;
+			} else if (i < 60) {
+				f = ((b & c) | (b & d) | (c & d)) + 0x8f1bbcdc;
+			} else {
+				f = (b ^ c ^ d) + 0xca62c1d6;
+			}
+			t = ROL(a, 5) + f + e + w[i];
+			e = d; d = c; c = ROL(b, 30); b = a; a = t;
+		}
+
+		st[0] += a; st[1] += b; st[2] += c; st[3] += d; st[4] += e;
+	}
+
+	for (i = 0; i < 5; i++) {
+		put_be(out + 4*i, st[i]);
+	}
+}
+
+unsigned int mhash_get_block_size(int hash)
+{
+	return (hash == MHASH_SHA1) ? 20 : 16;
+}
+
+MHASH mhash_init(int hash)
+{
+	MHASH h;
+
+	if (hash != MHASH_MD4 && hash != MHASH_MD5 && hash != MHASH_SHA1) {
+		return NULL;
+	}
+
+	h = (MHASH) malloc(sizeof(*h));
+	if (h == NULL) {
+		return NULL;
+	}
+
+	h->hash = hash;
+	h->buf = NULL;
+	h->buf_sz = 0;
+	h->alloc = 0;
+
+	return h;
+}
+
+int mhash(MHASH h, const void *input, size_t input_sz)
+{
+	unsigned char *buf;
+
+	if (h->buf_sz + input_sz > h->alloc) {
+		buf = (unsigned char*) realloc(h->buf, h->buf_sz + input_sz + 64);
+		if (buf == NULL) {
+			return -1;
+		}
+		h->buf = buf;
+		h->alloc = h->buf_sz + input_sz + 64;
+	}
+
+	memcpy(h->buf + h->buf_sz, input, input_sz);
+	h->buf_sz += input_sz;
+
+	return 0;
+}
+
+/*
+ * Finish the hash and free the handle.
+ * Returns a malloc'd buffer of mhash_get_block_size() bytes, or NULL.
+ */
+void *mhash_end(MHASH h)
+{
+	unsigned char *out;
+	size_t len;
+
+	out = (unsigned char*) malloc(mhash_get_block_size(h->hash));
+	len = md_pad(h, h->hash == MHASH_SHA1);
+
+	if (out != NULL && len != 0) {
+		switch (h->hash) {
+		case MHASH_MD4:
+			md4(h->buf, len, out);
+			break;
+		case MHASH_MD5:
+			md5(h->buf, len, out);
+			break;
+		case MHASH_SHA1:
+			sha1(h->buf, len, out);
+			break;
+		}
+	} else {
+		free(out);
+		out = NULL;
+	}
+
+	free(h->buf);
+	free(h);
+
+	return out;
+}
+
+#endif // SKEY_BUILTIN_HASH
@@ -0,0 +1,34 @@
+#ifndef SKEY_HASH_H
+#define SKEY_HASH_H
+
+/*
+ * Message digests used by skey.
+ *
+ * Normally this is just libmhash. When built with SKEY_BUILTIN_HASH defined,
+ * the small subset of the mhash API that skey uses is provided instead by
+ * hash.c, so that skey can be linked statically without any external
+ * libraries (see the skey-static target in the Makefile).
+ */
+
+#ifndef SKEY_BUILTIN_HASH
+
+#include <mhash.h>
+
+#else
+
+#include <stddef.h>
+
+#define MHASH_MD4	0
+#define MHASH_MD5	1
+#define MHASH_SHA1	2
+
+typedef struct skey_hash *MHASH;
+
+MHASH mhash_init(int hash);
+int mhash(MHASH h, const void *input, size_t input_sz);
+void *mhash_end(MHASH h);
+unsigned int mhash_get_block_size(int hash);
+
+#endif // SKEY_BUILTIN_HASH
+
+#endif // SKEY_HASH_H
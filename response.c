@@ -0,0 +1,308 @@
+/*
+ * S/Key response parser (RFC 2289 / RFC 2243)
+ *
+ * Walks the response once, left to right. Each helper advances *p past what it
+ * consumed, and on error leaves *p pointing at the offending input and returns
+ * a message.
+ */
+
+#include <limits.h>
+#include <string.h>
+#include "response.h"
+#include "words.h"
+
+static int is_space(char c)
+{
+	return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+static int is_alnum(char c)
+{
+	return (c >= '0' && c <= '9') || (c >= 'A' && c <= 'Z')
+		|| (c >= 'a' && c <= 'z');
+}
+
+static char to_lower(char c)
+{
+	return (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c;
+}
+
+static const char *skip_space(const char *p, const char *end)
+{
+	while (p < end && is_space(*p)) {
+		p++;
+	}
+	return p;
+}
+
+/*
+ * Case-insensitively match a NUL-terminated lowercase keyword against exactly
+ * len bytes of input.
+ */
+static int match(const char *p, size_t len, const char *keyword)
+{
+	size_t i;
+
+	for (i = 0; i < len; i++) {
+		if (keyword[i] == '\0' || to_lower(p[i]) != keyword[i]) {
+			return 0;
+		}
+	}
+
+	return keyword[len] == '\0';
+}
+
+/*
+ * If the input at p starts with the given type label (e.g. "hex:"), skip it
+ * and return nonzero.
+ */
+static int match_label(const char **p, const char *end, const char *label)
+{
+	size_t len = strlen(label);
+
+	if ((size_t) (end - *p) < len || !match(*p, len, label)) {
+		return 0;
+	}
+
+	*p += len;
+	return 1;
+}
+
+static int hex_value(char c)
+{
+	if (c >= '0' && c <= '9') {
+		return c - '0';
+	}
+	c = to_lower(c);
+	if (c >= 'a' && c <= 'f') {
+		return c - 'a' + 10;
+	}
+	return -1;
+}
+
+/*
+ * 16 hex digits, which RFC 2243 allows to be broken up by whitespace.
+ * Stops at ':' or the end of input.
+ */
+static const char *parse_hex(const char **p, const char *end, unsigned char otp[8])
+{
+	int n, v;
+
+	for (n = 0; *p < end && **p != ':'; (*p)++) {
+		if (is_space(**p)) {
+			continue;
+		}
+		v = hex_value(**p);
+		if (v < 0) {
+			return "invalid hex digit";
+		}
+		if (n == 16) {
+			return "too many hex digits";
+		}
+		if (n % 2 == 0) {
+			otp[n / 2] = v << 4;
+		} else {
+			otp[n / 2] |= v;
+		}
+		n++;
+	}
+
+	if (n < 16) {
+		return "too few hex digits";
+	}
+
+	return NULL;
+}
+
+/*
+ * Six whitespace-separated dictionary words, checksum included.
+ * Stops at ':' or the end of input.
+ */
+static const char *parse_words(const char **p, const char *end, unsigned char otp[8])
+{
+	int n, ret;
+	size_t len;
+	char words[6][5];
+	const char *start[6];
+
+	for (n = 0; ; n++) {
+		*p = skip_space(*p, end);
+		if (*p == end || **p == ':') {
+			break;
+		}
+		if (n == 6) {
+			return "too many words";
+		}
+
+		start[n] = *p;
+		while (*p < end && !is_space(**p) && **p != ':') {
+			(*p)++;
+		}
+
+		len = *p - start[n];
+		if (len > 4) {
+			*p = start[n];
+			return "unknown word";
+		}
+		memcpy(words[n], start[n], len);
+		words[n][len] = '\0';
+	}
+
+	if (n < 6) {
+		return "too few words";
+	}
+
+	ret = words_decode(words, otp);
+	if (ret == -1) {
+		*p = start[5];
+		return "bad checksum";
+	} else if (ret < 6) {
+		*p = start[ret];
+		return "unknown word";
+	}
+
+	return NULL;
+}
+
+/*
+ * "<algorithm> <sequence> <seed>", surrounded by optional whitespace.
+ */
+static const char *parse_params(const char **p, const char *end, struct skey_response *r)
+{
+	const char *start;
+
+	*p = skip_space(*p, end);
+	for (start = *p; *p < end && is_alnum(**p); (*p)++)
+		;
+	r->alg = start;
+	r->alg_len = *p - start;
+	if (!match(r->alg, r->alg_len, "md4")
+			&& !match(r->alg, r->alg_len, "md5")
+			&& !match(r->alg, r->alg_len, "sha1")) {
+		*p = start;
+		return "unknown algorithm";
+	}
+
+	*p = skip_space(*p, end);
+	r->seq = 0;
+	for (start = *p; *p < end && **p >= '0' && **p <= '9'; (*p)++) {
+		if (r->seq > (ULONG_MAX - 9) / 10) {
+			return "sequence number too large";
+		}
+		r->seq = r->seq * 10 + (**p - '0');
+	}
+	if (*p == start) {
+		return "missing sequence number";
+	} else if (*p < end && !is_space(**p)) {
+		return "invalid sequence number";
+	}
+
+	/* RFC 2289: 1 to 16 alphanumeric characters */
+	*p = skip_space(*p, end);
+	for (start = *p; *p < end && is_alnum(**p); (*p)++)
+		;
+	r->seed = start;
+	r->seed_len = *p - start;
+	if (r->seed_len < 1 || r->seed_len > 16) {
+		*p = start;
+		return "invalid seed";
+	}
+
+	*p = skip_space(*p, end);
+
+	return NULL;
+}
+
+/*
+ * Parse an OTP response of input_sz bytes (need not be NUL-terminated) into r.
+ * Returns NULL on success, otherwise a message describing the problem, with
+ * r->error_at pointing at the offending part of the input.
+ */
+const char *response_parse(const char *input, size_t input_sz, struct skey_response *r)
+{
+	const char *p, *end, *err;
+	int hex;
+
+	p = skip_space(input, input + input_sz);
+	end = input + input_sz;
+
+	memset(r, 0, sizeof(*r));
+
+	if (match_label(&p, end, "init-hex:")) {
+		r->init = 1;
+		hex = 1;
+	} else if (match_label(&p, end, "init-word:")) {
+		r->init = 1;
+		hex = 0;
+	} else if (match_label(&p, end, "hex:")) {
+		hex = 1;
+	} else {
+		/* "word:" is optional; bare words are a plain RFC 2289 response */
+		match_label(&p, end, "word:");
+		hex = 0;
+	}
+
+	err = hex ? parse_hex(&p, end, r->otp) : parse_words(&p, end, r->otp);
+
+	if (err == NULL && r->init) {
+		if (p == end || *p != ':') {
+			err = "missing new params";
+		} else {
+			p++;
+			err = parse_params(&p, end, r);
+		}
+
+		if (err == NULL) {
+			if (p == end || *p != ':') {
+				err = "missing new OTP";
+			} else {
+				p++;
+				err = hex ? parse_hex(&p, end, r->new_otp)
+					: parse_words(&p, end, r->new_otp);
+			}
+		}
+	}
+
+	if (err == NULL) {
+		p = skip_space(p, end);
+		if (p != end) {
+			err = "unexpected trailing input";
+		}
+	}
+
+	if (err != NULL) {
+		r->error_at = p;
+	}
+
+	return err;
+}
+
+/*
+
+Copyright (c) 2009, William R. Fraser
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of William R. Fraser nor the names of other
+      contributors may be used to endorse or promote products derived from
+      this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY WILLIAM R. FRASER ''AS IS'' AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL WILLIAM R. FRASER BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+vim: sts=8 ts=8 noexpandtab
+*/
@@ -0,0 +1,39 @@
+#ifndef SKEY_RESPONSE_H
+#define SKEY_RESPONSE_H
+
+#include <stddef.h>
+
+/*
+ * Parser for OTP responses, including the RFC 2243 extended responses:
+ *
+ *	<six words>
+ *	hex:<hex OTP>
+ *	word:<six words>
+ *	init-hex:<hex OTP>:<new params>:<new hex OTP>
+ *	init-word:<six words>:<new params>:<new six words>
+ *
+ * where <new params> is "<algorithm> <sequence> <seed>".
+ *
+ * The input is parsed in a single pass and never copied; the algorithm and
+ * seed of a re-initialization point back into the caller's buffer.
+ */
+
+struct skey_response {
+	int init;		/* nonzero for init-hex: and init-word: */
+	unsigned char otp[8];
+
+	/* the following are only set when init is nonzero */
+	const char *alg;	/* "md4", "md5" or "sha1", any case */
+	size_t alg_len;
+	unsigned long seq;
+	const char *seed;
+	size_t seed_len;
+	unsigned char new_otp[8];
+
+	/* on error, where in the input parsing stopped */
+	const char *error_at;
+};
+
+const char *response_parse(const char *input, size_t input_sz, struct skey_response *r);
+
+#endif // SKEY_RESPONSE_H
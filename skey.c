@@ -7,7 +7,9 @@
  * v1.1.1 2018-03-24 minor code cleanup (current release)
  *
  * compile with:
- *	gcc -o skey skey.c -lmhash
+ *	gcc -o skey skey.c dict.c -lmhash
+ * or, without mhash:
+ *	gcc -DSKEY_BUILTIN_HASH -o skey skey.c dict.c hash.c
  *
  * usage: skey [otp-<hash>] <rounds> <seed>
  *
@@ -21,10 +23,10 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
-#include <mhash.h>
 #include <string.h>
 #include <termios.h>
 #include "dict.h"
+#include "hash.h"
 #include "version.h"
 
 /*
@@ -82,14 +84,13 @@ void skey_getpass(const char *prompt, char **secret, size_t *secret_sz)
 
 /*
  * fold the hash down to 64 bits
- * After calling, the memory at output will point to 8 bytes.
+ * The 8 folded bytes are written to output, which must not overlap input.
+ * Nothing is allocated here; the caller owns both buffers.
  */
-void hash_finalize(int hash, char *input, char **output)
+void hash_finalize(int hash, char *input, char output[8])
 {
 	int i, j, oversize;
 
-	*output = (char*) malloc(8);
-
 	oversize = mhash_get_block_size(hash) - 8;
 	for (i = 0; i < oversize; i++) {
 		input[(i%8)] ^= input[(i+8)];
@@ -100,12 +101,12 @@ void hash_finalize(int hash, char *input, char **output)
 		// wtf.
 		for (i = 0; i < 2; i++) {
 			for (j = 0; j < 4; j++) {
-				(*output)[i*4+j] = input[(i+1)*4-j-1];
+				output[i*4+j] = input[(i+1)*4-j-1];
 			}
 		}
 	} else {
 		for (i = 0; i < 8; i++) {
-			(*output)[i] = input[i];
+			output[i] = input[i];
 		}
 	}
 }
@@ -117,21 +118,26 @@ void hash_finalize(int hash, char *input, char **output)
 int do_hash(int hash, int rounds, char *input, size_t input_sz, char **output, size_t *output_sz)
 {
 	MHASH h;
-	char *to_free;
+	char *digest;
+
+	*output = (char*) malloc(8);
+	if (*output == NULL) {
+		perror("error allocating hash buffer");
+		return -1;
+	}
 
 	while (--rounds > -1) {
 		h = mhash_init(hash);
 		mhash(h, input, input_sz);
-		input = (char *) mhash_end(h);
-		
-		to_free = input;
-		hash_finalize(hash, input, &input);
-		free(to_free);
+		digest = (char *) mhash_end(h);
+
+		/* fold straight into the output buffer, which is the next input */
+		hash_finalize(hash, digest, *output);
+		free(digest);
+		input = *output;
 		input_sz = 8;
-		
 	}
 
-	*output = input;	
 	*output_sz = 8;
 
 	return 0;
@@ -275,7 +281,9 @@ int main(int argc, char **argv)
 	input[input_sz] = '\0';
 
 	/* run the specified number of hash rounds */
-	do_hash(hashfunc, rounds + 1, input, input_sz, &output, &output_sz);
+	if (do_hash(hashfunc, rounds + 1, input, input_sz, &output, &output_sz) != 0) {
+		return 1;
+	}
 
 	/* get a hexadecimal string */
 	hash_hex(output, output_sz, &final, &final_sz);
@@ -284,7 +292,7 @@ int main(int argc, char **argv)
 	/* break hash into word chunks */
 	hash_break(output, chunks);
 
-	printf("%s\n%s %s %s %s %s %s\n", final, dict[chunks[0]], 
+	printf("%s\n%.4s %.4s %.4s %.4s %.4s %.4s\n", final, dict[chunks[0]], 
 		dict[chunks[1]], dict[chunks[2]], dict[chunks[3]],
 		dict[chunks[4]], dict[chunks[5]]); 
 
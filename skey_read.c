@@ -6,77 +6,45 @@
  * Reads in a 6-word RFC-2289-style OTP and outputs the corresponding
  * hexadecimal hash string.
  *
- * usage: skey_read <word1> <word2> <word3> <word4> <word5> <word6>
+ * Also accepts RFC 2243 extended responses ("hex:...", "word:...",
+ * "init-hex:..." and "init-word:..."). For the init forms, the new params and
+ * the new OTP are printed on two further lines.
  *
- * If run with fewer than 6 arguments, you will be promped to type the six
- * words at the terminal.
+ * usage: skey_read [<response>]
+ *
+ * e.g.   skey_read INCH SEA ANNE LONG AHEM TOUR
+ *        skey_read "init-hex:9e87 6134 d904 99dd:md5 499 ke1235:<new hex>"
+ *
+ * If run with no arguments, you will be promped to type the response at the
+ * terminal.
  *
  * For restrictions regarding usage and distribution, see license at the end of
  * this file.
  */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
-#include "dict.h"
+#include "response.h"
 #include "version.h"
 
-int dict_search(char *word)
+void print_hex(const unsigned char hash[8])
 {
 	int i;
-	char word_copy[5];
-	for (i = 0; i < 5 && word[i] > 0; i++) {
-		word_copy[i] = word[i];
-		if (word[i] <= 'z' && word[i] >= 'a') {
-			word_copy[i] += ('A' - 'a');
-		} else if (word[i] < 'A' || word[i] > 'z' || (word[i] > 'Z' && word[i] < 'a')) {
-			fprintf(stderr, "char out of bounds: %c\n", word[i]);
-			return -2;
-		}
-	}
-	word_copy[i] = '\0';
 
-	for (i = 0; i < 2048; i++) {
-		if (strcmp(dict[i], word_copy) == 0) {
-			return i;
-		}
-	}
-
-	return -1;
-}
-
-int combine_chunks(int chunkbits, int num_chunks, void *combined, unsigned long chunks[])
-{
-	int in, out, bits_in, bits_out;
-	unsigned long curr_chunk;
-
-	out = 0;
-	bits_out = 7;
-	*((unsigned char *)combined + out) = 0;
-	for (in = 0; in < num_chunks; in++) {
-		curr_chunk = chunks[in];
-		for (bits_in = chunkbits - 1; bits_in >= 0; bits_in--)
-		{
-			*((unsigned char *)combined + out) |= (curr_chunk & (1 << bits_in)) >> bits_in << bits_out;
-			bits_out--;
-			if (bits_out == -1) {
-				out++;
-				bits_out = 7;
-				*((unsigned char *)combined + out) = 0;
-			}
-		}
+	for (i = 0; i < 8; i++) {
+		printf("%.2x", hash[i]);
 	}
-
-	return out;
+	printf("\n");
 }
 
 int main(int argc, char **argv)
 {
-	int i, j, out;
-
-	int temp;
-	unsigned char combined[9]; // need two bits form #9
-	unsigned long chunks[6];
-	char words[6][5];
+	int i;
+	char *input;
+	const char *err;
+	size_t input_sz, alloc;
+	struct skey_response r;
 
 	if (argc == 2 && (
 			strcmp(argv[1], "--help") == 0
@@ -89,54 +57,60 @@ int main(int argc, char **argv)
 		fprintf(stderr, " (c) 2009 by William R. Fraser\n");
 		fprintf(stderr, "usage: %s [<word1> <word2> <word3> <word4> "
 				"<word5> <word6>]\n", argv[0]);
+		fprintf(stderr, "       %s [hex:|word:|init-hex:|init-word:]"
+				"<response>\n", argv[0]);
 		return -1;
 	}
 
-	if (argc < 7) {
+	if (argc < 2) {
+		alloc = 1024;
+		input = (char*) malloc(alloc);
+		if (input == NULL) {
+			perror("error allocating input buffer");
+			return -1;
+		}
 		fprintf(stderr, "enter s/key: ");
-		scanf("%4s %4s %4s %4s %4s %4s", words[0], words[1], words[2], words[3], words[4], words[5]);
+		if (fgets(input, alloc, stdin) == NULL) {
+			input[0] = '\0';
+		}
+		input_sz = strlen(input);
 	} else {
-		for (i = 0; i < 6; i++) {
-			for (j = 0; j < 5 && argv[i+1][j]; j++)
-				words[i][j] = argv[i+1][j];
-			words[i][j] = '\0';
+		/* join the arguments back into one response */
+		alloc = 0;
+		for (i = 1; i < argc; i++) {
+			alloc += strlen(argv[i]) + 1;
+		}
+		input = (char*) malloc(alloc);
+		if (input == NULL) {
+			perror("error allocating input buffer");
+			return -1;
+		}
+		input_sz = 0;
+		for (i = 1; i < argc; i++) {
+			if (i > 1) {
+				input[input_sz++] = ' ';
+			}
+			memcpy(input + input_sz, argv[i], strlen(argv[i]));
+			input_sz += strlen(argv[i]);
 		}
-	}
-	
-	for (i = 0; i < 6; i++) {
-		temp = dict_search(words[i]);
-		if (temp < 0) {
-			fprintf(stderr, "unknown word \"%s\" in input\n", words[i]);
-			return -2;
-		} 
-		chunks[i] = (unsigned long) temp;
 	}
 
-	out = combine_chunks(11, 6, (void*) combined, chunks);
-
-	/*
-	for (i = 0; i < 6; i++) {
-		printf("chunk %d: %lu:\t", i, chunks[i]);
-		for (j = 10; j >= 0; j--) {
-			printf("%lu%s", (chunks[i] & (1 << j)) >> j, (((i*11 + (11-j)) % 8) == 0) ? " " : "" );
-		}
-		printf("\n");
+	err = response_parse(input, input_sz, &r);
+	if (err != NULL) {
+		fprintf(stderr, "%s in input at \"%.*s\"\n", err,
+			(int) (input + input_sz - r.error_at), r.error_at);
+		return -2;
 	}
 
-	printf("\ncombined:");
-	for (i = 0; i <= out; i++) {
-		printf(" ");
-		for (j = 7; j >= 0; j--) {
-			printf("%d", (combined[i] & (1 << j)) >> j);
-		}
+	print_hex(r.otp);
+
+	if (r.init) {
+		printf("%.*s %lu %.*s\n", (int) r.alg_len, r.alg, r.seq,
+			(int) r.seed_len, r.seed);
+		print_hex(r.new_otp);
 	}
-	printf("\n");
-	*/
 
-	for (i = 0; i < 8; i++) {
-                printf("%.2x", combined[i]);
-        }
-	printf("\n");
+	free(input);
 
 	return 0;
 }
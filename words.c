@@ -0,0 +1,147 @@
+/*
+ * S/Key word decoding
+ *
+ * Split out of skey_read.c so the six-word -> 64-bit conversion can be reused
+ * by other programs.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "dict.h"
+#include "words.h"
+
+int dict_search(char *word)
+{
+	int i;
+	char word_copy[5];
+	for (i = 0; i < 4 && word[i] > 0; i++) {
+		word_copy[i] = word[i];
+		if (word[i] <= 'z' && word[i] >= 'a') {
+			word_copy[i] += ('A' - 'a');
+		} else if (word[i] < 'A' || word[i] > 'z' || (word[i] > 'Z' && word[i] < 'a')) {
+			fprintf(stderr, "char out of bounds: %c\n", word[i]);
+			return -2;
+		}
+	}
+	word_copy[i] = '\0';
+
+	/* dictionary entries are at most 4 chars and may not be terminated */
+	if (word[i] > 0) {
+		return -1;
+	}
+
+	for (i = 0; i < 2048; i++) {
+		if (strncmp(dict[i], word_copy, 4) == 0) {
+			return i;
+		}
+	}
+
+	return -1;
+}
+
+int combine_chunks(int chunkbits, int num_chunks, void *combined, unsigned long chunks[])
+{
+	int in, out, bits_in, bits_out;
+	unsigned long curr_chunk;
+
+	out = 0;
+	bits_out = 7;
+	*((unsigned char *)combined + out) = 0;
+	for (in = 0; in < num_chunks; in++) {
+		curr_chunk = chunks[in];
+		for (bits_in = chunkbits - 1; bits_in >= 0; bits_in--)
+		{
+			*((unsigned char *)combined + out) |= (curr_chunk & (1 << bits_in)) >> bits_in << bits_out;
+			bits_out--;
+			if (bits_out == -1) {
+				out++;
+				bits_out = 7;
+				*((unsigned char *)combined + out) = 0;
+			}
+		}
+	}
+
+	return out;
+}
+
+/*
+ * Compute the RFC 2289 checksum of an 8-byte hash: the sum of all its 2-bit
+ * pairs, mod 4. This is the same checksum skey's hash_break() appends to the
+ * last word.
+ */
+int words_checksum(const unsigned char hash[8])
+{
+	int i, byte, checksum;
+
+	checksum = 0;
+	for (i = 0; i < 8; i++) {
+		byte = hash[i];
+		checksum += byte & 0x03;
+		checksum += (byte & 0x0C) >> 2;
+		checksum += (byte & 0x30) >> 4;
+		checksum += (byte & 0xC0) >> 6;
+	}
+
+	return checksum & 3;
+}
+
+/*
+ * Convert six dictionary words into the 8-byte hash they encode, and verify
+ * the checksum carried in the low two bits of the last word.
+ * Returns 6 on success, -1 if the checksum doesn't match, otherwise the index
+ * of the first word that isn't in the dictionary.
+ */
+int words_decode(char words[6][5], unsigned char hash[8])
+{
+	int i, temp;
+	unsigned char combined[9]; // need two bits form #9
+	unsigned long chunks[6];
+
+	for (i = 0; i < 6; i++) {
+		temp = dict_search(words[i]);
+		if (temp < 0) {
+			return i;
+		}
+		chunks[i] = (unsigned long) temp;
+	}
+
+	combine_chunks(11, 6, (void*) combined, chunks);
+
+	if ((combined[8] >> 6) != words_checksum(combined)) {
+		return -1;
+	}
+
+	memcpy(hash, combined, 8);
+
+	return 6;
+}
+
+/*
+
+Copyright (c) 2009, William R. Fraser
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of William R. Fraser nor the names of other
+      contributors may be used to endorse or promote products derived from
+      this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY WILLIAM R  FRASER ''AS IS'' AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL WILLIAM R. FRASER BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+vim: sts=8 ts=8 noexpandtab
+*/
@@ -0,0 +1,16 @@
+#ifndef SKEY_WORDS_H
+#define SKEY_WORDS_H
+
+/*
+ * Decoding of RFC-2289 six-word OTPs back into the 64-bit hash.
+ *
+ * This has no dependencies beyond libc and dict.o, so anything that needs to
+ * turn a user's response into the value to verify can link it directly.
+ */
+
+int dict_search(char *word);
+int combine_chunks(int chunkbits, int num_chunks, void *combined, unsigned long chunks[]);
+int words_checksum(const unsigned char hash[8]);
+int words_decode(char words[6][5], unsigned char hash[8]);
+
+#endif // SKEY_WORDS_H